@@ -4,7 +4,7 @@
 
 void generic_clear_irq(struct genip_device *gdev, uint32_t irq_status)
 {
-	genip_write_reg(gdev->mmio, gdev->platform_data->irq_clear_reg, irq_status);
+	genip_write_reg(gdev, gdev->platform_data->irq_clear_reg, irq_status);
 }
 
 void d2d_clear_irq(struct genip_device *gdev, uint32_t irq_status)
@@ -39,65 +39,65 @@ void d2d_clear_irq(struct genip_device *gdev, uint32_t irq_status)
     clear_reg.bits.clr_dlist = status_reg.bits.irq_dlist;
     clear_reg.bits.clr_bus = status_reg.bits.irq_bus;
 
-	genip_write_reg(gdev->mmio, gdev->platform_data->irq_clear_reg, clear_reg.value);
+	genip_write_reg(gdev, gdev->platform_data->irq_clear_reg, clear_reg.value);
 }
 
 const struct genip_platform_data genip_cdc_pdata = {
-	.fs_dev_name = "cdc",
+	.fs_dev_name = GENIP_DEV_NAME_CDC,
 	.irq_name = "cdc_irq",
-	.version_reg = 0,
+	.version_reg = GENIP_CDC_REG_VERSION,
 	.version_reg_mask = 0xffffff00,
 	.version_reg_expected = 0xcdc00400,
-	.irq_status_reg = 0x0e,
-	.irq_clear_reg = 0x0f,
+	.irq_status_reg = GENIP_CDC_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_CDC_REG_IRQ_CLEAR,
 	.irq_clear_func = generic_clear_irq,};
 
 const struct genip_platform_data genip_dhd_pdata = {
-	.fs_dev_name = "dhd",
+	.fs_dev_name = GENIP_DEV_NAME_DHD,
 	.irq_name = "dhd_irq",
-	.version_reg = 0,
+	.version_reg = GENIP_DHD_REG_VERSION,
 	.version_reg_mask = 0xff000000,
 	.version_reg_expected = 0xd4000000,
-	.irq_status_reg = 0x06,
-	.irq_clear_reg = 0x06,
+	.irq_status_reg = GENIP_DHD_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_DHD_REG_IRQ_CLEAR,
 	.irq_clear_func = generic_clear_irq,};
 
 const struct genip_platform_data genip_warp_pdata = {
-	.fs_dev_name = "warp",
+	.fs_dev_name = GENIP_DEV_NAME_WARP,
 	.irq_name = "warp_irq",
-	.version_reg = 0x0,
+	.version_reg = GENIP_WARP_REG_VERSION,
 	.version_reg_mask = 0xffff0000,
 	.version_reg_expected = 0xdead0000, // No tag and version checking yet
-	.irq_status_reg = 0x11,
-	.irq_clear_reg = 0x12,
+	.irq_status_reg = GENIP_WARP_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_WARP_REG_IRQ_CLEAR,
 	.irq_clear_func = generic_clear_irq,};
 
 const struct genip_platform_data genip_d2d_pdata = {
-	.fs_dev_name = "d2d",
+	.fs_dev_name = GENIP_DEV_NAME_D2D,
 	.irq_name = "d2d_irq",
-	.version_reg = 0,
+	.version_reg = GENIP_D2D_REG_VERSION,
 	/* todo: reg mask and expected value */
-	.irq_status_reg = 0x00,
-	.irq_clear_reg = 0x30,
+	.irq_status_reg = GENIP_D2D_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_D2D_REG_IRQ_CLEAR,
 	.irq_clear_func = d2d_clear_irq,}; //TODO IRQ status reg
 
 const struct genip_platform_data genip_fbd_pdata = {
-	.fs_dev_name = "fbd",
+	.fs_dev_name = GENIP_DEV_NAME_FBD,
 	.irq_name = "fbd_irq",
-	.version_reg = 0,
-	.version_reg = 0,
+	.version_reg = GENIP_FBD_REG_VERSION,
+	.version_reg = GENIP_FBD_REG_VERSION,
 	.version_reg_mask = 0xffff0000, // No version checking yet
 	.version_reg_expected = 0x44430000,
-	.irq_status_reg = 0x02,
-	.irq_clear_reg = 0x02,
+	.irq_status_reg = GENIP_FBD_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_FBD_REG_IRQ_CLEAR,
 	.irq_clear_func = generic_clear_irq,};
 
 const struct genip_platform_data genip_dsw_pdata = {
-	.fs_dev_name = "dsw",
+	.fs_dev_name = GENIP_DEV_NAME_DSW,
 	.irq_name = "dsw_irq",
-	.version_reg = 0,
+	.version_reg = GENIP_DSW_REG_VERSION,
 	.version_reg_mask = 0xffffff00,
 	.version_reg_expected = 0xde570100,
-	.irq_status_reg = 0x02,
-	.irq_clear_reg = 0x02,
+	.irq_status_reg = GENIP_DSW_REG_IRQ_STATUS,
+	.irq_clear_reg = GENIP_DSW_REG_IRQ_CLEAR,
 	.irq_clear_func = generic_clear_irq,};
@@ -3,13 +3,7 @@
 
 #include "genip_driver.h"
 #include "genip_io.h"
-
-#define GENIP_COMPAT_STR_CDC "tes,cdc-2.1"
-#define GENIP_COMPAT_STR_DHD "tes,dhd-1.0"
-#define GENIP_COMPAT_STR_WARP "tes,warp-1.0"
-#define GENIP_COMPAT_STR_D2D "tes,d2d-1.0"
-#define GENIP_COMPAT_STR_FBD "tes,fbd-1.0"
-#define GENIP_COMPAT_STR_DSW "tes,dsw-1.0"
+#include "genip_regs.h"
 
 // struct to hold data specific to each IP that is compatible with this driver
 struct genip_platform_data {
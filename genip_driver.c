@@ -24,6 +24,7 @@
 #include "genip_io.h"
 #include "genip_devices.h"
 #include "genip_module.h"
+#include "genip_trace.h"
 // TODO cleanup includes
 
 static int genip_probe(struct platform_device *pdev);
@@ -64,9 +65,93 @@ static void genip_print_infos(struct genip_device *tes_dev) {
 	dev_info(tes_dev->base_dev, "Base address:\t0x%08lx - 0x%08lx\n",
 			 tes_dev->base_phys, tes_dev->base_phys + tes_dev->span);
 	dev_info(tes_dev->base_dev, "IRQ:\t%d\n", tes_dev->irq_no);
-	hwversion = genip_read_reg(tes_dev->mmio, tes_dev->platform_data->version_reg);
+	hwversion = genip_read_reg(tes_dev, tes_dev->platform_data->version_reg);
 	dev_info(tes_dev->base_dev, "IP core rev. 0x%08X\n", hwversion);
 }
+
+/*
+ * sysfs attributes
+ * irq_cpu:   CPU the IRQ is steered to via affinity hint, -1 for none
+ *            steering the IRQ to the reader's CPU is what avoids the cross-CPU wakeup IPI
+ * wake_cpu:  "irq" (default), "reader" or a CPU number to wake readers on
+ *            a remote wakeup is handed over by irq_work, which still costs an IPI;
+ *            this only moves where the wakeup runs, e.g. off a busy IRQ CPU
+ * irq_stats: per-CPU count of handled IRQs and reader wakeups
+ */
+static ssize_t irq_cpu_show(struct device *dev, struct device_attribute *attr, char *buf) {
+	struct genip_device *tes_dev = dev_get_drvdata(dev);
+
+	return sprintf(buf, "%d\n", tes_dev->irq_cpu);
+}
+
+static ssize_t irq_cpu_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count) {
+	struct genip_device *tes_dev = dev_get_drvdata(dev);
+	int cpu;
+	int result;
+
+	result = kstrtoint(buf, 0, &cpu);
+	if (result)
+		return result;
+
+	result = genip_irq_set_cpu(tes_dev, cpu);
+	return result ? result : count;
+}
+static DEVICE_ATTR_RW(irq_cpu);
+
+static ssize_t wake_cpu_show(struct device *dev, struct device_attribute *attr, char *buf) {
+	struct genip_device *tes_dev = dev_get_drvdata(dev);
+	int cpu = READ_ONCE(tes_dev->wake_cpu);
+
+	if (cpu == GENIP_WAKE_IRQ_CPU)
+		return sprintf(buf, "irq\n");
+	if (cpu == GENIP_WAKE_READER_CPU)
+		return sprintf(buf, "reader\n");
+	return sprintf(buf, "%d\n", cpu);
+}
+
+static ssize_t wake_cpu_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count) {
+	struct genip_device *tes_dev = dev_get_drvdata(dev);
+	unsigned int cpu;
+
+	if (sysfs_streq(buf, "irq")) {
+		WRITE_ONCE(tes_dev->wake_cpu, GENIP_WAKE_IRQ_CPU);
+	} else if (sysfs_streq(buf, "reader")) {
+		WRITE_ONCE(tes_dev->wake_cpu, GENIP_WAKE_READER_CPU);
+	} else {
+		if (kstrtouint(buf, 0, &cpu) || cpu >= nr_cpu_ids || !cpu_online(cpu))
+			return -EINVAL;
+		WRITE_ONCE(tes_dev->wake_cpu, cpu);
+	}
+
+	return count;
+}
+static DEVICE_ATTR_RW(wake_cpu);
+
+static ssize_t irq_stats_show(struct device *dev, struct device_attribute *attr, char *buf) {
+	struct genip_device *tes_dev = dev_get_drvdata(dev);
+	struct genip_irq_stats *stats;
+	ssize_t len = 0;
+	int cpu;
+
+	len += scnprintf(buf + len, PAGE_SIZE - len, "cpu\tirqs\twakeups\n");
+	for_each_possible_cpu(cpu) {
+		stats = per_cpu_ptr(tes_dev->irq_stats, cpu);
+		len += scnprintf(buf + len, PAGE_SIZE - len, "%d\t%lu\t%lu\n",
+				 cpu, READ_ONCE(stats->irqs), READ_ONCE(stats->wakeups));
+	}
+
+	return len;
+}
+static DEVICE_ATTR_RO(irq_stats);
+
+static struct attribute *genip_attrs[] = {
+	&dev_attr_irq_cpu.attr,
+	&dev_attr_wake_cpu.attr,
+	&dev_attr_irq_stats.attr,
+	NULL,
+};
+ATTRIBUTE_GROUPS(genip);
+
 /*
  * probe function (init new hardware)
  * copy all neccessary data from device tree description to local data structure and initialize the driver part.
@@ -87,6 +172,7 @@ static int genip_probe(struct platform_device *pdev) {
 	int str_idx = 0;                    /* index for streaming devices */
 	int str_anz_dev = 0;                /* count of streaming devices */
 	int str_ret;                        /* returnvalue of parse_phandle */
+	uint32_t irq_cpu;
 
 	// calculate the new dev_t for the device created here
 	current_dev_t = MKDEV(genip_global->major, genip_global->dev_count);
@@ -101,6 +187,8 @@ static int genip_probe(struct platform_device *pdev) {
 		goto ALLOC_MEM_FAILED;
 	}
 
+	tes_dev->minor = MINOR(current_dev_t);
+
 	// retrieve data from device tree
 	of_device_match = of_match_device(genip_of_ids, &pdev->dev);
 	tes_dev->platform_data = of_device_match->data;
@@ -121,7 +209,7 @@ static int genip_probe(struct platform_device *pdev) {
 	tes_dev->span = mem->end - mem->start;
 
 	// check IP core version
-	hwversion = genip_read_reg(tes_dev->mmio, tes_dev->platform_data->version_reg)
+	hwversion = genip_read_reg(tes_dev, tes_dev->platform_data->version_reg)
 		& tes_dev->platform_data->version_reg_mask;
 	if(hwversion != tes_dev->platform_data->version_reg_expected) {
 		dev_err(&pdev->dev, "Unsupported IP core version: %08x\n", hwversion);
@@ -139,10 +227,21 @@ static int genip_probe(struct platform_device *pdev) {
 	// init spinlock and irq
 	spin_lock_init(&tes_dev->irq_slck);
 	init_waitqueue_head(&tes_dev->irq_waitq);
+	init_irq_work(&tes_dev->wake_work, genip_irq_wake_work);
+	tes_dev->irq_cpu = -1;
+	tes_dev->wake_cpu = GENIP_WAKE_IRQ_CPU;
+	tes_dev->reader_cpu = -1;
+	tes_dev->irq_stats = devm_alloc_percpu(&pdev->dev, struct genip_irq_stats);
+	if (!tes_dev->irq_stats) {
+		dev_err(&pdev->dev,
+				"Memory allocation for IRQ statistics failed!\n");
+		result = -ENOMEM;
+		goto ALLOC_MEM_FAILED;
+	}
 
 	// register device and create sys-file
-	tes_dev->base_dev = device_create(genip_global->class, NULL,
-		current_dev_t, tes_dev, tes_dev->platform_data->fs_dev_name);
+	tes_dev->base_dev = device_create_with_groups(genip_global->class, NULL,
+		current_dev_t, tes_dev, genip_groups, tes_dev->platform_data->fs_dev_name);
 	if (!tes_dev->base_dev) {
 		dev_err(tes_dev->base_dev, "can't create device: %s\n", tes_dev->platform_data->fs_dev_name);
 		result = -EBUSY;
@@ -217,6 +316,11 @@ static int genip_probe(struct platform_device *pdev) {
 		tes_dev->connected_stream_dev_count = str_anz_dev;
 	}
 
+	// optionally steer the IRQ to the CPU given in the device tree
+	if (!device_property_read_u32(&pdev->dev, "tes,irq-cpu", &irq_cpu)
+			&& genip_irq_set_cpu(tes_dev, irq_cpu))
+		dev_warn(tes_dev->base_dev, "can't set IRQ affinity to CPU %u\n", irq_cpu);
+
 	return 0;
 
 IRQ_FAILED:
@@ -234,7 +338,14 @@ STREAM_DEVICE_FAILED:
 static int genip_remove(struct platform_device *pdev) {
 	struct genip_device *tes_dev = platform_get_drvdata(pdev);
 
+	// removes the sysfs attributes first, so irq_cpu can't set the hint again
 	device_destroy(genip_global->class, tes_dev->base_dev->devt);
+
+	// the IRQ is released by devm after this; no wakeup work may be left behind
+	irq_set_affinity_hint(tes_dev->irq_no, NULL);
+	disable_irq(tes_dev->irq_no);
+	irq_work_sync(&tes_dev->wake_work);
+
 	return 0;
 }
 
@@ -275,6 +386,10 @@ static int __init _genip_init(void) {
 		goto CDEV_ADD_FAILED;
 	}
 
+	// register access recording; optional, so failures are not fatal
+	if (genip_trace_init())
+		pr_warn("register access recording not available\n");
+
 	// register actual driver
 	// this invokes a call to genip_probe for each ip core
 	result = platform_driver_register(&genip_driver);
@@ -288,6 +403,7 @@ static int __init _genip_init(void) {
 	return 0;
 
 PLATFORM_REGISTER_FAILED:
+	genip_trace_exit();
 	cdev_del(&genip_global->cdev);
 CDEV_ADD_FAILED:
 	unregister_chrdev_region(first_dev_t, GENIP_MAX_DEVICES);
@@ -300,6 +416,7 @@ ALLOC_GLOBAL_FAILED:
 
 static void __exit _genip_exit(void) {
 	platform_driver_unregister(&genip_driver);
+	genip_trace_exit();
 	class_destroy(genip_global->class);
 	cdev_del(&genip_global->cdev);
 	unregister_chrdev_region(MKDEV(genip_global->major, 0), GENIP_MAX_DEVICES);
@@ -3,12 +3,24 @@
 
 #include <linux/cdev.h>
 #include <linux/device.h>
+#include <linux/irq_work.h>
+#include <linux/percpu.h>
 #include <linux/platform_device.h>
 
 #include "genip_module.h"
 
 struct genip_platform_data;
 
+// values of genip_device.wake_cpu besides a CPU number
+#define GENIP_WAKE_IRQ_CPU (-1)    /* wake readers on the CPU handling the IRQ */
+#define GENIP_WAKE_READER_CPU (-2) /* wake readers on the CPU they went to sleep on */
+
+// per-CPU IRQ accounting, shown in sysfs as irq_stats
+struct genip_irq_stats {
+	unsigned long irqs;
+	unsigned long wakeups;
+};
+
 struct genip_device { // TODO replace unsigned long with u32 etc (maybe dont????); whatever, CHECK ALL DATA TYPES!!!
 	unsigned long base_phys;
 	unsigned long span;
@@ -17,7 +29,13 @@ struct genip_device { // TODO replace unsigned long with u32 etc (maybe dont????
 	uint32_t irq_stat; /* contents of IRQ status register */
 	spinlock_t irq_slck;
 	wait_queue_head_t irq_waitq;
+	int irq_cpu; /* CPU set as IRQ affinity hint, -1 if none */
+	int wake_cpu; /* CPU number or GENIP_WAKE_* */
+	int reader_cpu; /* CPU of the last reader waiting for an IRQ, -1 if none */
+	struct irq_work wake_work; /* wakes readers on another CPU */
+	struct genip_irq_stats __percpu *irq_stats;
 	dev_t dev_t;
+	unsigned int minor; /* index in genip_global->device_by_minor */
 	struct device *base_dev;
 	struct genip_stream_dev *stream_dev[GENIP_MAX_STREAMS];
 	int connected_stream_dev_count;
@@ -4,17 +4,31 @@
 #include <linux/export.h>
 #include <linux/fs.h>
 #include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/mm.h>
+#include <linux/poll.h>
+#include <linux/sched/signal.h>
+#include <linux/smp.h>
+#include <linux/slab.h>
 #include <linux/uaccess.h>
 
 #include "genip_driver.h"
 #include "genip_devices.h"
 #include "genip_io.h"
 #include "genip_module.h"
+#include "genip_trace.h"
+
+// bounce buffer size for block accesses, in 32 bit words
+#define GENIP_BLOCK_CHUNK_WORDS (PAGE_SIZE / sizeof(uint32_t))
+// bounce buffer size for batches, in ops
+#define GENIP_BATCH_CHUNK_OPS (PAGE_SIZE / sizeof(struct genip_batch_op))
 
 static int genip_open(struct inode *ip, struct file *fp);
 static long genip_ioctl(struct file *fp, unsigned int cmd, unsigned long arg);
 static ssize_t genip_write(struct file *file, const char __user *user_input, size_t count, loff_t *offset);
 static ssize_t genip_read(struct file *filp, char __user *buff, size_t count, loff_t *offp);
+static __poll_t genip_poll(struct file *filp, poll_table *wait);
+static int genip_mmap(struct file *filp, struct vm_area_struct *vma);
 
 struct file_operations genip_fops = {
 	.owner = THIS_MODULE,
@@ -22,17 +36,155 @@ struct file_operations genip_fops = {
 	.unlocked_ioctl = genip_ioctl,
 	.read = genip_read,
 	.write = genip_write,
+	.poll = genip_poll,
+	.mmap = genip_mmap,
 };
 
-uint32_t genip_read_reg(void *reg_base_virt, uint32_t reg_id) {
+uint32_t genip_read_reg(struct genip_device *gdev, uint32_t reg_id) {
 	// shift == *4 == conversion from register ids aka word addresses to byte addresses
-	uint32_t value = ioread32((void *)((size_t)reg_base_virt + (reg_id << 2)));
+	uint32_t value = ioread32((void *)((size_t)gdev->mmio + (reg_id << 2)));
+	genip_trace(gdev, GENIP_TRACE_OP_READ, reg_id, value);
 	return value;
 }
 
-void genip_write_reg(void *reg_base_virt, uint32_t reg_id, uint32_t value) {
+void genip_write_reg(struct genip_device *gdev, uint32_t reg_id, uint32_t value) {
 	// shift == *4 == conversion from register ids aka word addresses to byte addresses
-	iowrite32(value, (void *)((size_t)reg_base_virt + (reg_id << 2)));
+	iowrite32(value, (void *)((size_t)gdev->mmio + (reg_id << 2)));
+	genip_trace(gdev, GENIP_TRACE_OP_WRITE, reg_id, value);
+}
+
+static inline uint64_t genip_reg_count(struct genip_device *gdev) {
+	// span is the offset of the last byte
+	return ((uint64_t)gdev->span + 1) >> 2;
+}
+
+/*
+ * read/write a range of registers for GENIP_IOCTL_BLOCK_R/W
+ * __ioread32_copy/__iowrite32_copy are used instead of memcpy_fromio/memcpy_toio
+ * since the registers must only be accessed with 32 bit wide accesses.
+ */
+static int genip_block_access(struct genip_device *gdev, struct genip_block_access *blk, bool write) {
+	uint32_t __user *udata = u64_to_user_ptr(blk->data);
+	bool fixed = blk->flags & GENIP_BLOCK_FLAG_FIXED;
+	uint64_t reg_count = genip_reg_count(gdev);
+	uint32_t reg_id = blk->offset;
+	size_t chunk_size = min_t(size_t, blk->count, GENIP_BLOCK_CHUNK_WORDS);
+	size_t done = 0;
+	size_t todo;
+	void __iomem *addr;
+	uint32_t *buf;
+	int result = 0;
+
+	if (blk->flags & ~GENIP_BLOCK_FLAG_FIXED)
+		return -EINVAL;
+	if (!blk->count)
+		return 0;
+	if (blk->offset >= reg_count || (!fixed && blk->count > reg_count - blk->offset))
+		return -EINVAL;
+
+	buf = kmalloc_array(chunk_size, sizeof(uint32_t), GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	while (done < blk->count) {
+		todo = min_t(size_t, blk->count - done, chunk_size);
+		addr = gdev->mmio + ((fixed ? reg_id : reg_id + done) << 2);
+
+		if (write) {
+			if (copy_from_user(buf, udata + done, todo * sizeof(uint32_t))) {
+				result = -EFAULT;
+				break;
+			}
+			if (fixed)
+				iowrite32_rep(addr, buf, todo);
+			else
+				__iowrite32_copy(addr, buf, todo);
+			genip_trace_block(gdev, GENIP_TRACE_OP_WRITE, fixed ? reg_id : reg_id + done, buf, todo, fixed);
+		} else {
+			if (fixed)
+				ioread32_rep(addr, buf, todo);
+			else
+				__ioread32_copy(buf, addr, todo);
+			genip_trace_block(gdev, GENIP_TRACE_OP_READ, fixed ? reg_id : reg_id + done, buf, todo, fixed);
+			if (copy_to_user(udata + done, buf, todo * sizeof(uint32_t))) {
+				result = -EFAULT;
+				break;
+			}
+		}
+		done += todo;
+
+		// FIXED accesses are not bounded by the span; stay preemptible and killable
+		if (done < blk->count) {
+			if (fatal_signal_pending(current)) {
+				result = -EINTR;
+				break;
+			}
+			cond_resched();
+		}
+	}
+
+	kfree(buf);
+	return result;
+}
+
+// execute the register accesses of a GENIP_IOCTL_BATCH in order
+static int genip_batch(struct genip_device *gdev, struct genip_batch *batch) {
+	struct genip_batch_op __user *uops = u64_to_user_ptr(batch->ops);
+	size_t chunk_size = min_t(size_t, batch->count, GENIP_BATCH_CHUNK_OPS);
+	uint64_t reg_count = genip_reg_count(gdev);
+	size_t done = 0;
+	size_t todo;
+	size_t i;
+	struct genip_batch_op *ops;
+	int result = 0;
+
+	if (!batch->count)
+		return 0;
+
+	ops = kmalloc_array(chunk_size, sizeof(struct genip_batch_op), GFP_KERNEL);
+	if (!ops)
+		return -ENOMEM;
+
+	while (done < batch->count) {
+		todo = min_t(size_t, batch->count - done, chunk_size);
+		if (copy_from_user(ops, uops + done, todo * sizeof(struct genip_batch_op))) {
+			result = -EFAULT;
+			break;
+		}
+
+		for (i = 0; i < todo; i++) {
+			if (ops[i].reg >= reg_count) {
+				result = -EINVAL;
+				break;
+			}
+			if (ops[i].op == GENIP_BATCH_OP_WRITE) {
+				genip_write_reg(gdev, ops[i].reg, ops[i].value);
+			} else if (ops[i].op == GENIP_BATCH_OP_READ) {
+				ops[i].value = genip_read_reg(gdev, ops[i].reg);
+			} else {
+				result = -EINVAL;
+				break;
+			}
+		}
+
+		// hand out the values read so far, also if an op was invalid
+		if (copy_to_user(uops + done, ops, i * sizeof(struct genip_batch_op)) && !result)
+			result = -EFAULT;
+		if (result)
+			break;
+		done += todo;
+
+		if (done < batch->count) {
+			if (fatal_signal_pending(current)) {
+				result = -EINTR;
+				break;
+			}
+			cond_resched();
+		}
+	}
+
+	kfree(ops);
+	return result;
 }
 
 static int genip_open(struct inode *ip, struct file *fp) {
@@ -51,6 +203,8 @@ static long genip_ioctl(struct file *fp, unsigned int cmd, unsigned long arg) {
 	struct genip_device *gdev = fp->private_data;
 	unsigned int cmd_nr;
 	struct genip_reg_access ipcore_reg_access;
+	struct genip_block_access ipcore_block_access;
+	struct genip_batch ipcore_batch;
 	struct genip_settings ipcore_settings;
 	struct genip_stream_dev stream_dev[GENIP_MAX_STREAMS];
 	int str_idx = 0;
@@ -70,7 +224,7 @@ static long genip_ioctl(struct file *fp, unsigned int cmd, unsigned long arg) {
 			if (copy_from_user(&ipcore_reg_access, (struct ipcore_reg_access __user *)arg,
 					sizeof(ipcore_reg_access)))
 				return -EFAULT;
-			genip_write_reg(gdev->mmio, ipcore_reg_access.offset,
+			genip_write_reg(gdev, ipcore_reg_access.offset,
 					ipcore_reg_access.value);
 			break;
 
@@ -80,12 +234,26 @@ static long genip_ioctl(struct file *fp, unsigned int cmd, unsigned long arg) {
 					sizeof(ipcore_reg_access)))
 				return -EFAULT;
 
-			ipcore_reg_access.value = genip_read_reg(gdev->mmio, ipcore_reg_access.offset);
+			ipcore_reg_access.value = genip_read_reg(gdev, ipcore_reg_access.offset);
 			if (copy_to_user((struct ipcore_reg_access __user *)arg,
 					&ipcore_reg_access, sizeof(ipcore_reg_access)))
 				return -EFAULT;
 			break;
 
+		// write / read a range of registers
+		case GENIP_IOCTL_NR_BLOCK_WRITE:
+		case GENIP_IOCTL_NR_BLOCK_READ:
+			if (copy_from_user(&ipcore_block_access, (struct genip_block_access __user *)arg,
+					sizeof(ipcore_block_access)))
+				return -EFAULT;
+			return genip_block_access(gdev, &ipcore_block_access, cmd_nr == GENIP_IOCTL_NR_BLOCK_WRITE);
+
+		// execute a list of register accesses
+		case GENIP_IOCTL_NR_BATCH:
+			if (copy_from_user(&ipcore_batch, (struct genip_batch __user *)arg, sizeof(ipcore_batch)))
+				return -EFAULT;
+			return genip_batch(gdev, &ipcore_batch);
+
 		// retrieve the register memory settings
 		case GENIP_IOCTL_NR_SETTINGS:
 			ipcore_settings.base_phys = gdev->base_phys;
@@ -132,9 +300,17 @@ static long genip_ioctl(struct file *fp, unsigned int cmd, unsigned long arg) {
 static ssize_t genip_read(struct file *filp, char __user *buff, size_t count, loff_t *offp) {
 	struct genip_device *dev = filp->private_data;
 	unsigned long flags;
+	int reader_cpu;
 	int temp;
 
+	if ((filp->f_flags & O_NONBLOCK) && !READ_ONCE(dev->irq_stat))
+		return -EAGAIN;
+
+	// remembered for GENIP_WAKE_READER_CPU, forgotten again unless another reader took over
+	reader_cpu = raw_smp_processor_id();
+	WRITE_ONCE(dev->reader_cpu, reader_cpu);
 	wait_event_interruptible(dev->irq_waitq, dev->irq_stat);
+	cmpxchg(&dev->reader_cpu, reader_cpu, -1);
 
 	spin_lock_irqsave(&dev->irq_slck, flags);
 	temp = dev->irq_stat;
@@ -148,6 +324,36 @@ static ssize_t genip_read(struct file *filp, char __user *buff, size_t count, lo
 
 	return 0;
 }
+
+// readable as soon as an IRQ is pending, so IRQs can be waited for with poll/epoll
+static __poll_t genip_poll(struct file *filp, poll_table *wait) {
+	struct genip_device *dev = filp->private_data;
+
+	poll_wait(filp, &dev->irq_waitq, wait);
+
+	return READ_ONCE(dev->irq_stat) ? EPOLLIN | EPOLLRDNORM : 0;
+}
+
+/*
+ * map the registers to userspace, starting at offset 0
+ * Note that accesses through the mapping bypass register access recording.
+ */
+static int genip_mmap(struct file *filp, struct vm_area_struct *vma) {
+	struct genip_device *dev = filp->private_data;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	if (vma->vm_pgoff || (dev->base_phys & ~PAGE_MASK) || size > PAGE_ALIGN(dev->span + 1))
+		return -EINVAL;
+
+	// accesses through a mapping bypass the recorder, so clients have to use the ioctls
+	if (genip_trace_enabled())
+		return -EBUSY;
+
+	vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+
+	return io_remap_pfn_range(vma, vma->vm_start, dev->base_phys >> PAGE_SHIFT, size, vma->vm_page_prot);
+}
+
 static ssize_t genip_write(struct file *file, const char __user *user_input, size_t count, loff_t *offset) {
 	struct genip_device *gdev = file->private_data;
 	char buf[33];
@@ -177,18 +383,53 @@ static ssize_t genip_write(struct file *file, const char __user *user_input, siz
 	return count;
 }
 
+static void genip_irq_wake_readers(struct genip_device *dev) {
+	this_cpu_inc(dev->irq_stats->wakeups);
+	wake_up_interruptible(&dev->irq_waitq);
+}
+
+void genip_irq_wake_work(struct irq_work *work) {
+	genip_irq_wake_readers(container_of(work, struct genip_device, wake_work));
+}
+
+// steer the IRQ to cpu, or remove the affinity hint if cpu < 0
+int genip_irq_set_cpu(struct genip_device *dev, int cpu) {
+	int result;
+
+	if (cpu >= 0 && (cpu >= nr_cpu_ids || !cpu_online(cpu)))
+		return -EINVAL;
+
+	result = irq_set_affinity_hint(dev->irq_no, cpu < 0 ? NULL : cpumask_of(cpu));
+	if (result)
+		return result;
+
+	dev->irq_cpu = cpu < 0 ? -1 : cpu;
+	return 0;
+}
+
 irqreturn_t genip_irq_handler(int irq, void *dev_raw) {
 	unsigned long flags;
 	struct genip_device *dev = dev_raw;
+	int wake_cpu;
 
-	uint32_t irq_status = genip_read_reg(dev->mmio, dev->platform_data->irq_status_reg); 
+	uint32_t irq_status = genip_read_reg(dev, dev->platform_data->irq_status_reg); 
+	genip_trace(dev, GENIP_TRACE_OP_IRQ, dev->platform_data->irq_status_reg, irq_status);
 	dev->platform_data->irq_clear_func(dev, irq_status);
+	this_cpu_inc(dev->irq_stats->irqs);
 
 	spin_lock_irqsave(&dev->irq_slck, flags);
 	dev->irq_stat |= irq_status;
 	spin_unlock_irqrestore(&dev->irq_slck, flags);
 
-	wake_up_interruptible(&dev->irq_waitq);
+	// wake the readers locally or hand the wakeup to the selected CPU
+	wake_cpu = READ_ONCE(dev->wake_cpu);
+	if (wake_cpu == GENIP_WAKE_READER_CPU)
+		wake_cpu = READ_ONCE(dev->reader_cpu);
+
+	if (wake_cpu < 0 || wake_cpu == smp_processor_id() || !cpu_online(wake_cpu))
+		genip_irq_wake_readers(dev);
+	else
+		irq_work_queue_on(&dev->wake_work, wake_cpu);
 
 	return IRQ_HANDLED;
 }
@@ -2,16 +2,21 @@
 #define GENIP_FOPS_H
 
 #include <linux/interrupt.h>
+#include <linux/irq_work.h>
 #include <linux/types.h>
 
 /**
  * File operations and interrupt handeling
  */
 
+struct genip_device;
+
 extern struct file_operations genip_fops;
 
 irqreturn_t genip_irq_handler(int irq, void *dev_raw);
-uint32_t genip_read_reg(void* reg_base_virt, uint32_t reg_id);
-void genip_write_reg(void* reg_base_virt, uint32_t reg_id, uint32_t value);
+void genip_irq_wake_work(struct irq_work *work);
+int genip_irq_set_cpu(struct genip_device *gdev, int cpu);
+uint32_t genip_read_reg(struct genip_device *gdev, uint32_t reg_id);
+void genip_write_reg(struct genip_device *gdev, uint32_t reg_id, uint32_t value);
 
-#endif // GENIP_FOPS_H
\ No newline at end of file
+#endif // GENIP_FOPS_H
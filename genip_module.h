@@ -27,6 +27,12 @@
 #define GENIP_IOCTL_NR_STREAM_DEV (0x04)
 // get stream device count
 #define GENIP_IOCTL_NR_STREAM_DEV_COUNT (0x05)
+// write a contiguous range of registers
+#define GENIP_IOCTL_NR_BLOCK_WRITE (0x06)
+// read a contiguous range of registers
+#define GENIP_IOCTL_NR_BLOCK_READ (0x07)
+// execute a list of register accesses
+#define GENIP_IOCTL_NR_BATCH (0x08)
 
 // argument = pointer to genip_reg_access
 #define GENIP_IOCTL_W (_IOW(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_REG_WRITE, struct genip_reg_access))
@@ -38,6 +44,12 @@
 #define GENIP_IOCTL_GET_STREAM_DEV (_IOR(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_STREAM_DEV, struct genip_stream_dev *))
 // argument = pointer to write the count of a connected streaming device to
 #define GENIP_IOCTL_GET_STREAM_DEV_COUNT (_IOR(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_STREAM_DEV_COUNT, int))
+// argument = pointer to genip_block_access
+#define GENIP_IOCTL_BLOCK_W (_IOW(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_BLOCK_WRITE, struct genip_block_access))
+// argument = pointer to genip_block_access
+#define GENIP_IOCTL_BLOCK_R (_IOW(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_BLOCK_READ, struct genip_block_access))
+// argument = pointer to genip_batch
+#define GENIP_IOCTL_BATCH (_IOW(GENIP_IOCTL_TYPE, GENIP_IOCTL_NR_BATCH, struct genip_batch))
 
 /*
  * char device config & device tree matching
@@ -65,10 +77,67 @@ struct genip_reg_access {
 	__u32 value;          /* in/out, register value read or written */
 };
 
+// access the same register count times instead of a range (e.g. a CLUT data port)
+#define GENIP_BLOCK_FLAG_FIXED 0x01
+
+/* This struct is used for reading/writing a range of registers in one call.
+   data points to count 32 bit words in userspace. */
+struct genip_block_access {
+	__u64 offset;         /* in, first register ID */
+	__u64 data;           /* in, userspace buffer to read from / write to */
+	__u32 count;          /* in, number of registers */
+	__u32 flags;          /* in, GENIP_BLOCK_FLAG_* */
+};
+
+#define GENIP_BATCH_OP_READ 0x00
+#define GENIP_BATCH_OP_WRITE 0x01
+
+/* One access of a batch; batches access arbitrary, non-contiguous registers. */
+struct genip_batch_op {
+	__u32 reg;            /* in, register ID */
+	__u32 value;          /* in for writes, out for reads */
+	__u32 op;             /* in, GENIP_BATCH_OP_* */
+	__u32 reserved;
+};
+
+/* This struct is used for executing count genip_batch_ops in order.
+   Execution stops at the first invalid op. */
+struct genip_batch {
+	__u64 ops;            /* in, userspace array of genip_batch_op */
+	__u32 count;          /* in, number of ops */
+	__u32 reserved;
+};
+
 /* This structure is used for working with connected streaming devices */
 struct genip_stream_dev {
 	char dev_name[DEV_NAME_MAX_LEN];
 	int layer;
 };
 
+/*
+ * register access recording
+ * records are streamed from <debugfs>/tes-ipcore/trace while recording is
+ * enabled via <debugfs>/tes-ipcore/trace_enable
+ * mmap() of the registers fails with EBUSY while recording is enabled; accesses
+ * through mappings created before recording was enabled are not recorded
+ */
+
+#define GENIP_TRACE_OP_READ 0x00  // register read
+#define GENIP_TRACE_OP_WRITE 0x01 // register write
+#define GENIP_TRACE_OP_IRQ 0x02   // interrupt, value = IRQ status
+
+// access was done by the driver in interrupt context (e.g. clearing the IRQ)
+#define GENIP_TRACE_FLAG_IRQ_CTX 0x01
+
+/* One recorded register access or interrupt. */
+struct genip_trace_record {
+	__u64 ts;            /* CLOCK_MONOTONIC timestamp in ns */
+	__u32 reg;           /* register ID */
+	__u32 value;         /* value read / written, IRQ status for GENIP_TRACE_OP_IRQ */
+	__u8 dev;            /* minor number of the device */
+	__u8 op;             /* GENIP_TRACE_OP_* */
+	__u8 flags;          /* GENIP_TRACE_FLAG_* */
+	__u8 reserved[5];
+};
+
 #endif // GENIP_MODULE_H
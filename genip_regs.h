@@ -0,0 +1,80 @@
+#ifndef GENIP_REGS_H
+#define GENIP_REGS_H
+
+/*
+ * Description of the supported IP cores and their registers.
+ * This file is shared by the kernel driver (genip_devices.c) and libgenip;
+ * the per-IP register enums and the libgenip type tables are generated from
+ * the X-macro lists below. It can be included in kernel or userspace code.
+ */
+
+#define GENIP_COMPAT_STR_CDC "tes,cdc-2.1"
+#define GENIP_COMPAT_STR_DHD "tes,dhd-1.0"
+#define GENIP_COMPAT_STR_WARP "tes,warp-1.0"
+#define GENIP_COMPAT_STR_D2D "tes,d2d-1.0"
+#define GENIP_COMPAT_STR_FBD "tes,fbd-1.0"
+#define GENIP_COMPAT_STR_DSW "tes,dsw-1.0"
+
+// name of the device created in /dev/
+#define GENIP_DEV_NAME_CDC "cdc"
+#define GENIP_DEV_NAME_DHD "dhd"
+#define GENIP_DEV_NAME_WARP "warp"
+#define GENIP_DEV_NAME_D2D "d2d"
+#define GENIP_DEV_NAME_FBD "fbd"
+#define GENIP_DEV_NAME_DSW "dsw"
+
+// X(ID) for every supported IP core
+#define GENIP_IPCORES(X) \
+	X(CDC) \
+	X(DHD) \
+	X(WARP) \
+	X(D2D) \
+	X(FBD) \
+	X(DSW)
+
+/*
+ * register maps; X(ID, NAME, register id)
+ * Only add registers whose offsets are taken from the IP documentation.
+ */
+
+#define GENIP_CDC_REGS(X) \
+	X(CDC, VERSION, 0x00) \
+	X(CDC, IRQ_STATUS, 0x0e) \
+	X(CDC, IRQ_CLEAR, 0x0f)
+
+#define GENIP_DHD_REGS(X) \
+	X(DHD, VERSION, 0x00) \
+	X(DHD, IRQ_STATUS, 0x06) \
+	X(DHD, IRQ_CLEAR, 0x06)
+
+#define GENIP_WARP_REGS(X) \
+	X(WARP, VERSION, 0x00) \
+	X(WARP, IRQ_STATUS, 0x11) \
+	X(WARP, IRQ_CLEAR, 0x12)
+
+#define GENIP_D2D_REGS(X) \
+	X(D2D, VERSION, 0x00) \
+	X(D2D, IRQ_STATUS, 0x00) \
+	X(D2D, IRQ_CLEAR, 0x30)
+
+#define GENIP_FBD_REGS(X) \
+	X(FBD, VERSION, 0x00) \
+	X(FBD, IRQ_STATUS, 0x02) \
+	X(FBD, IRQ_CLEAR, 0x02)
+
+#define GENIP_DSW_REGS(X) \
+	X(DSW, VERSION, 0x00) \
+	X(DSW, IRQ_STATUS, 0x02) \
+	X(DSW, IRQ_CLEAR, 0x02)
+
+// generates e.g. enum genip_cdc_reg { GENIP_CDC_REG_VERSION = 0x00, ... }
+#define GENIP_REG_ENUM_ENTRY(ID, NAME, REG) GENIP_##ID##_REG_##NAME = (REG),
+
+enum genip_cdc_reg { GENIP_CDC_REGS(GENIP_REG_ENUM_ENTRY) };
+enum genip_dhd_reg { GENIP_DHD_REGS(GENIP_REG_ENUM_ENTRY) };
+enum genip_warp_reg { GENIP_WARP_REGS(GENIP_REG_ENUM_ENTRY) };
+enum genip_d2d_reg { GENIP_D2D_REGS(GENIP_REG_ENUM_ENTRY) };
+enum genip_fbd_reg { GENIP_FBD_REGS(GENIP_REG_ENUM_ENTRY) };
+enum genip_dsw_reg { GENIP_DSW_REGS(GENIP_REG_ENUM_ENTRY) };
+
+#endif // GENIP_REGS_H
@@ -0,0 +1,137 @@
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/hardirq.h>
+#include <linux/kfifo.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
+
+#include "genip_driver.h"
+#include "genip_module.h"
+#include "genip_trace.h"
+
+/*
+ * Records are collected in a kfifo. Writers (ioctl, IRQ handler, ...) are
+ * serialized by a spinlock, the single reader of the debugfs file by a mutex.
+ * If userspace does not keep up, new records are dropped and counted.
+ */
+
+static unsigned int trace_buf_records = 16384;
+module_param(trace_buf_records, uint, 0444);
+MODULE_PARM_DESC(trace_buf_records, "Size of the register access recording buffer in records");
+
+DEFINE_STATIC_KEY_FALSE(genip_trace_key);
+
+static DECLARE_KFIFO_PTR(genip_trace_fifo, struct genip_trace_record);
+static DEFINE_SPINLOCK(genip_trace_lock);
+static DEFINE_MUTEX(genip_trace_read_mutex);
+static DECLARE_WAIT_QUEUE_HEAD(genip_trace_waitq);
+static unsigned long genip_trace_dropped;
+static struct dentry *genip_trace_dir;
+
+void __genip_trace(struct genip_device *gdev, uint8_t op, uint32_t reg, uint32_t value) {
+	struct genip_trace_record rec = {
+		.ts = ktime_get_ns(),
+		.reg = reg,
+		.value = value,
+		.dev = gdev->minor,
+		.op = op,
+		.flags = in_interrupt() ? GENIP_TRACE_FLAG_IRQ_CTX : 0,
+	};
+	unsigned long flags;
+
+	spin_lock_irqsave(&genip_trace_lock, flags);
+	if (!kfifo_put(&genip_trace_fifo, rec))
+		genip_trace_dropped++;
+	spin_unlock_irqrestore(&genip_trace_lock, flags);
+
+	if (wq_has_sleeper(&genip_trace_waitq))
+		wake_up_interruptible(&genip_trace_waitq);
+}
+
+static ssize_t genip_trace_read(struct file *fp, char __user *buff, size_t count, loff_t *offp) {
+	unsigned int copied;
+	int result;
+
+	// only whole records are handed out
+	count = rounddown(count, sizeof(struct genip_trace_record));
+	if (!count)
+		return -EINVAL;
+
+	if (kfifo_is_empty(&genip_trace_fifo)) {
+		if (fp->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		result = wait_event_interruptible(genip_trace_waitq, !kfifo_is_empty(&genip_trace_fifo));
+		if (result)
+			return result;
+	}
+
+	mutex_lock(&genip_trace_read_mutex);
+	result = kfifo_to_user(&genip_trace_fifo, buff, count, &copied);
+	mutex_unlock(&genip_trace_read_mutex);
+
+	return result ? result : copied;
+}
+
+static const struct file_operations genip_trace_fops = {
+	.owner = THIS_MODULE,
+	.open = nonseekable_open,
+	.read = genip_trace_read,
+	.llseek = no_llseek,
+};
+
+static ssize_t genip_trace_enable_read(struct file *fp, char __user *buff, size_t count, loff_t *offp) {
+	char buf[2] = {static_key_enabled(&genip_trace_key) ? '1' : '0', '\n'};
+
+	return simple_read_from_buffer(buff, count, offp, buf, sizeof(buf));
+}
+
+static ssize_t genip_trace_enable_write(struct file *fp, const char __user *buff, size_t count, loff_t *offp) {
+	bool enable;
+	int result;
+
+	result = kstrtobool_from_user(buff, count, &enable);
+	if (result)
+		return result;
+
+	if (enable)
+		static_branch_enable(&genip_trace_key);
+	else
+		static_branch_disable(&genip_trace_key);
+
+	return count;
+}
+
+static const struct file_operations genip_trace_enable_fops = {
+	.owner = THIS_MODULE,
+	.read = genip_trace_enable_read,
+	.write = genip_trace_enable_write,
+	.llseek = default_llseek,
+};
+
+int genip_trace_init(void) {
+	int result;
+
+	result = kfifo_alloc(&genip_trace_fifo, trace_buf_records, GFP_KERNEL);
+	if (result) {
+		pr_err("Memory allocation for register access recording failed!\n");
+		return result;
+	}
+
+	genip_trace_dir = debugfs_create_dir(GENIP_DRIVER_NAME, NULL);
+	debugfs_create_file("trace", 0400, genip_trace_dir, NULL, &genip_trace_fops);
+	debugfs_create_file("trace_enable", 0600, genip_trace_dir, NULL, &genip_trace_enable_fops);
+	debugfs_create_ulong("trace_dropped", 0400, genip_trace_dir, &genip_trace_dropped);
+
+	return 0;
+}
+
+void genip_trace_exit(void) {
+	static_branch_disable(&genip_trace_key);
+	debugfs_remove_recursive(genip_trace_dir);
+	genip_trace_dir = NULL;
+	kfifo_free(&genip_trace_fifo);
+}
@@ -0,0 +1,50 @@
+#ifndef GENIP_TRACE_H
+#define GENIP_TRACE_H
+
+#include <linux/jump_label.h>
+#include <linux/types.h>
+
+/**
+ * Recording of register accesses and interrupts for offline analysis
+ */
+
+struct genip_device;
+
+#ifdef CONFIG_DEBUG_FS
+DECLARE_STATIC_KEY_FALSE(genip_trace_key);
+
+void __genip_trace(struct genip_device *gdev, uint8_t op, uint32_t reg, uint32_t value);
+int genip_trace_init(void);
+void genip_trace_exit(void);
+
+static inline bool genip_trace_enabled(void) {
+	return static_key_enabled(&genip_trace_key);
+}
+
+// cheap enough for the register access path; a patched nop while recording is off
+static inline void genip_trace(struct genip_device *gdev, uint8_t op, uint32_t reg, uint32_t value) {
+	if (static_branch_unlikely(&genip_trace_key))
+		__genip_trace(gdev, op, reg, value);
+}
+
+// one record per register of a block access
+static inline void genip_trace_block(struct genip_device *gdev, uint8_t op, uint32_t reg,
+		const uint32_t *values, size_t count, bool fixed) {
+	size_t i;
+
+	if (!static_branch_unlikely(&genip_trace_key))
+		return;
+
+	for (i = 0; i < count; i++)
+		__genip_trace(gdev, op, fixed ? reg : reg + i, values[i]);
+}
+#else
+static inline bool genip_trace_enabled(void) { return false; }
+static inline void genip_trace(struct genip_device *gdev, uint8_t op, uint32_t reg, uint32_t value) { }
+static inline void genip_trace_block(struct genip_device *gdev, uint8_t op, uint32_t reg,
+		const uint32_t *values, size_t count, bool fixed) { }
+static inline int genip_trace_init(void) { return 0; }
+static inline void genip_trace_exit(void) { }
+#endif // CONFIG_DEBUG_FS
+
+#endif // GENIP_TRACE_H
@@ -0,0 +1,317 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "genip.h"
+
+#define GENIP_DEV_DIR "/dev/"
+
+struct genip_dev {
+	int fd;
+	struct genip_settings settings;
+	uint32_t reg_count;          /* number of 32 bit registers in the register area */
+	volatile uint32_t *regs;     /* register mapping, NULL if not available */
+	size_t map_size;
+	int has_block_ioctl;         /* cleared once the driver rejects the block ioctls */
+	int has_batch_ioctl;         /* cleared once the driver rejects the batch ioctl */
+};
+
+#define GENIP_IP_NAME_ENTRY(ID) [GENIP_IP_##ID] = GENIP_DEV_NAME_##ID,
+static const char *const genip_ip_names[GENIP_IP_COUNT] = {
+	GENIP_IPCORES(GENIP_IP_NAME_ENTRY)
+};
+
+const char *genip_ip_name(enum genip_ip_type type) {
+	if ((unsigned int)type >= GENIP_IP_COUNT)
+		return NULL;
+	return genip_ip_names[type];
+}
+
+static void genip_map_regs(struct genip_dev *dev) {
+	const char *no_mmap = getenv("GENIP_NO_MMAP");
+	long page_size = sysconf(_SC_PAGESIZE);
+	void *regs;
+
+	if (no_mmap && strcmp(no_mmap, "0"))
+		return;
+
+	dev->map_size = ((size_t)dev->settings.span + page_size) & ~((size_t)page_size - 1);
+	regs = mmap(NULL, dev->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, 0);
+	if (regs == MAP_FAILED)
+		return;
+
+	dev->regs = regs;
+}
+
+struct genip_dev *genip_open_path(const char *path) {
+	struct genip_dev *dev;
+	int err;
+
+	dev = calloc(1, sizeof(struct genip_dev));
+	if (!dev)
+		return NULL;
+
+	dev->fd = open(path, O_RDWR | O_CLOEXEC);
+	if (dev->fd < 0)
+		goto OPEN_FAILED;
+
+	if (ioctl(dev->fd, GENIP_IOCTL_GET_SETTINGS, &dev->settings) < 0)
+		goto SETTINGS_FAILED;
+
+	// span is the offset of the last byte of the register area
+	dev->reg_count = ((uint64_t)dev->settings.span + 1) >> 2;
+	dev->has_block_ioctl = 1;
+	dev->has_batch_ioctl = 1;
+	genip_map_regs(dev);
+
+	return dev;
+
+SETTINGS_FAILED:
+	err = errno;
+	close(dev->fd);
+	errno = err;
+OPEN_FAILED:
+	free(dev);
+	return NULL;
+}
+
+struct genip_dev *genip_open(enum genip_ip_type type) {
+	char path[64];
+	const char *name = genip_ip_name(type);
+
+	if (!name) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(path, sizeof(path), GENIP_DEV_DIR "%s", name);
+	return genip_open_path(path);
+}
+
+void genip_close(struct genip_dev *dev) {
+	if (!dev)
+		return;
+
+	if (dev->regs)
+		munmap((void *)dev->regs, dev->map_size);
+	close(dev->fd);
+	free(dev);
+}
+
+int genip_fd(const struct genip_dev *dev) {
+	return dev->fd;
+}
+
+int genip_is_mapped(const struct genip_dev *dev) {
+	return dev->regs != NULL;
+}
+
+const struct genip_settings *genip_get_settings(const struct genip_dev *dev) {
+	return &dev->settings;
+}
+
+int genip_read_reg(struct genip_dev *dev, uint32_t reg, uint32_t *value) {
+	struct genip_reg_access access = {.offset = reg};
+
+	if (reg >= dev->reg_count)
+		return -EINVAL;
+
+	if (dev->regs) {
+		*value = dev->regs[reg];
+		return 0;
+	}
+
+	if (ioctl(dev->fd, GENIP_IOCTL_R, &access) < 0)
+		return -errno;
+
+	*value = access.value;
+	return 0;
+}
+
+int genip_write_reg(struct genip_dev *dev, uint32_t reg, uint32_t value) {
+	struct genip_reg_access access = {.offset = reg, .value = value};
+
+	if (reg >= dev->reg_count)
+		return -EINVAL;
+
+	if (dev->regs) {
+		dev->regs[reg] = value;
+		return 0;
+	}
+
+	if (ioctl(dev->fd, GENIP_IOCTL_W, &access) < 0)
+		return -errno;
+
+	return 0;
+}
+
+static int genip_check_block(const struct genip_dev *dev, uint32_t reg, size_t count, uint32_t flags) {
+	if (flags & ~GENIP_BLOCK_FLAG_FIXED)
+		return -EINVAL;
+	if (reg >= dev->reg_count)
+		return -EINVAL;
+	if (!(flags & GENIP_BLOCK_FLAG_FIXED) && count > dev->reg_count - reg)
+		return -EINVAL;
+	if (count > UINT32_MAX)
+		return -EINVAL;
+	return 0;
+}
+
+/*
+ * try the block ioctl; returns 1 if the driver does not support it.
+ * Bounds were checked before, so -EINVAL/-ENOTTY mean an older driver.
+ */
+static int genip_block_ioctl(struct genip_dev *dev, unsigned long cmd, uint32_t reg, const uint32_t *values,
+		size_t count, uint32_t flags) {
+	struct genip_block_access blk = {
+		.offset = reg,
+		.data = (uintptr_t)values,
+		.count = count,
+		.flags = flags,
+	};
+
+	if (!dev->has_block_ioctl)
+		return 1;
+
+	if (ioctl(dev->fd, cmd, &blk) == 0)
+		return 0;
+
+	if (errno == EINVAL || errno == ENOTTY) {
+		dev->has_block_ioctl = 0;
+		return 1;
+	}
+	return -errno;
+}
+
+int genip_read_block(struct genip_dev *dev, uint32_t reg, uint32_t *values, size_t count, uint32_t flags) {
+	int fixed = flags & GENIP_BLOCK_FLAG_FIXED;
+	size_t i;
+	int result;
+
+	result = genip_check_block(dev, reg, count, flags);
+	if (result)
+		return result;
+
+	if (dev->regs) {
+		for (i = 0; i < count; i++)
+			values[i] = dev->regs[fixed ? reg : reg + i];
+		return 0;
+	}
+
+	result = genip_block_ioctl(dev, GENIP_IOCTL_BLOCK_R, reg, values, count, flags);
+	if (result <= 0)
+		return result;
+
+	for (i = 0; i < count; i++) {
+		result = genip_read_reg(dev, fixed ? reg : reg + i, &values[i]);
+		if (result)
+			return result;
+	}
+	return 0;
+}
+
+int genip_write_block(struct genip_dev *dev, uint32_t reg, const uint32_t *values, size_t count, uint32_t flags) {
+	int fixed = flags & GENIP_BLOCK_FLAG_FIXED;
+	size_t i;
+	int result;
+
+	result = genip_check_block(dev, reg, count, flags);
+	if (result)
+		return result;
+
+	if (dev->regs) {
+		for (i = 0; i < count; i++)
+			dev->regs[fixed ? reg : reg + i] = values[i];
+		return 0;
+	}
+
+	result = genip_block_ioctl(dev, GENIP_IOCTL_BLOCK_W, reg, values, count, flags);
+	if (result <= 0)
+		return result;
+
+	for (i = 0; i < count; i++) {
+		result = genip_write_reg(dev, fixed ? reg : reg + i, values[i]);
+		if (result)
+			return result;
+	}
+	return 0;
+}
+
+int genip_batch(struct genip_dev *dev, struct genip_batch_op *ops, size_t count) {
+	struct genip_batch batch = {
+		.ops = (uintptr_t)ops,
+		.count = count,
+	};
+	size_t i;
+	int result;
+
+	if (count > UINT32_MAX)
+		return -EINVAL;
+	for (i = 0; i < count; i++) {
+		if (ops[i].reg >= dev->reg_count)
+			return -EINVAL;
+		if (ops[i].op != GENIP_BATCH_OP_READ && ops[i].op != GENIP_BATCH_OP_WRITE)
+			return -EINVAL;
+	}
+
+	if (dev->regs) {
+		for (i = 0; i < count; i++) {
+			if (ops[i].op == GENIP_BATCH_OP_WRITE)
+				dev->regs[ops[i].reg] = ops[i].value;
+			else
+				ops[i].value = dev->regs[ops[i].reg];
+		}
+		return 0;
+	}
+
+	// ops were checked before, so -EINVAL/-ENOTTY mean an older driver
+	if (dev->has_batch_ioctl) {
+		if (ioctl(dev->fd, GENIP_IOCTL_BATCH, &batch) == 0)
+			return 0;
+		if (errno != EINVAL && errno != ENOTTY)
+			return -errno;
+		dev->has_batch_ioctl = 0;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (ops[i].op == GENIP_BATCH_OP_WRITE)
+			result = genip_write_reg(dev, ops[i].reg, ops[i].value);
+		else
+			result = genip_read_reg(dev, ops[i].reg, &ops[i].value);
+		if (result)
+			return result;
+	}
+	return 0;
+}
+
+int genip_wait_irq(struct genip_dev *dev, int timeout_ms, uint32_t *irq_status) {
+	struct pollfd pfd = {.fd = dev->fd, .events = POLLIN};
+	uint32_t status;
+	ssize_t len;
+	int result;
+
+	do {
+		result = poll(&pfd, 1, timeout_ms);
+	} while (result < 0 && errno == EINTR);
+
+	if (result < 0)
+		return -errno;
+	if (result == 0)
+		return -ETIMEDOUT;
+
+	len = read(dev->fd, &status, sizeof(status));
+	if (len < 0)
+		return -errno;
+	if (len != sizeof(status))
+		return -EIO;
+
+	if (irq_status)
+		*irq_status = status;
+	return 0;
+}
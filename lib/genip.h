@@ -0,0 +1,79 @@
+#ifndef LIBGENIP_H
+#define LIBGENIP_H
+
+/*
+ * libgenip - userspace client library for the tes-ipcore driver
+ *
+ * Register accesses automatically take the cheapest path the driver offers:
+ *  1. registers mapped into the process (no syscall per access)
+ *  2. GENIP_IOCTL_BLOCK_R/W for ranges and GENIP_IOCTL_BATCH for lists of
+ *     non-contiguous accesses (one syscall each)
+ *  3. GENIP_IOCTL_R/W per register, if the driver lacks the above
+ * The driver refuses mappings while it records register accesses, so devices
+ * opened during a recording use the ioctl paths. Devices opened before the
+ * recording was enabled keep their mapping and are not recorded; set
+ * GENIP_NO_MMAP=1 in the environment to force the ioctl paths anyway.
+ *
+ * Functions returning int return 0 on success and a negative errno on failure.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "genip_module.h"
+#include "genip_regs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// generates GENIP_IP_CDC, GENIP_IP_DHD, ...
+#define GENIP_IP_ENUM_ENTRY(ID) GENIP_IP_##ID,
+enum genip_ip_type {
+	GENIP_IPCORES(GENIP_IP_ENUM_ENTRY)
+	GENIP_IP_COUNT
+};
+
+struct genip_dev;
+
+// name of the device in /dev/, NULL for an invalid type
+const char *genip_ip_name(enum genip_ip_type type);
+
+// open the device of the given IP type; NULL on failure with errno set
+struct genip_dev *genip_open(enum genip_ip_type type);
+// open a device by path, e.g. "/dev/dhd"; NULL on failure with errno set
+struct genip_dev *genip_open_path(const char *path);
+void genip_close(struct genip_dev *dev);
+
+// file descriptor of the device; readable (POLLIN) while an IRQ is pending
+int genip_fd(const struct genip_dev *dev);
+// nonzero if register accesses go through a mapping of the registers
+int genip_is_mapped(const struct genip_dev *dev);
+// physical base address and size of the register area
+const struct genip_settings *genip_get_settings(const struct genip_dev *dev);
+
+int genip_read_reg(struct genip_dev *dev, uint32_t reg, uint32_t *value);
+int genip_write_reg(struct genip_dev *dev, uint32_t reg, uint32_t value);
+
+// read / write count registers starting at reg; flags are GENIP_BLOCK_FLAG_*
+int genip_read_block(struct genip_dev *dev, uint32_t reg, uint32_t *values, size_t count, uint32_t flags);
+int genip_write_block(struct genip_dev *dev, uint32_t reg, const uint32_t *values, size_t count, uint32_t flags);
+
+/*
+ * execute count register accesses in order; reads store their result in
+ * ops[i].value. Fails with -EINVAL before any access if an op is invalid.
+ */
+int genip_batch(struct genip_dev *dev, struct genip_batch_op *ops, size_t count);
+
+/*
+ * wait for an IRQ and return the accumulated IRQ status
+ * timeout_ms < 0 waits forever; returns -ETIMEDOUT if no IRQ occurred.
+ * For epoll, add genip_fd() with EPOLLIN and call this with timeout_ms = 0.
+ */
+int genip_wait_irq(struct genip_dev *dev, int timeout_ms, uint32_t *irq_status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIBGENIP_H
@@ -0,0 +1,133 @@
+#ifndef LIBGENIP_HPP
+#define LIBGENIP_HPP
+
+/*
+ * C++ bindings for libgenip
+ *
+ *   genip::Ip<genip::DHD> dhd;
+ *   dhd.write(genip::DHD::Reg::IRQ_CLEAR, 0x1);
+ *   uint32_t status = dhd.waitIrq();
+ *
+ * Errors are reported as std::system_error. Requires C++11.
+ */
+
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+
+#include "genip.h"
+
+namespace genip {
+
+[[noreturn]] inline void throwError(int err, const char *what) {
+	throw std::system_error(err < 0 ? -err : err, std::generic_category(), what);
+}
+
+inline void check(int result, const char *what) {
+	if (result < 0)
+		throwError(result, what);
+}
+
+// owns an open device; untyped register ids
+class Device {
+public:
+	explicit Device(genip_ip_type type) : dev_(genip_open(type)) {
+		if (!dev_)
+			throwError(errno, "genip_open");
+	}
+
+	explicit Device(const char *path) : dev_(genip_open_path(path)) {
+		if (!dev_)
+			throwError(errno, "genip_open_path");
+	}
+
+	~Device() { genip_close(dev_); }
+
+	Device(const Device &) = delete;
+	Device &operator=(const Device &) = delete;
+	Device(Device &&other) noexcept : dev_(other.dev_) { other.dev_ = nullptr; }
+	Device &operator=(Device &&other) noexcept {
+		std::swap(dev_, other.dev_);
+		return *this;
+	}
+
+	uint32_t read(uint32_t reg) {
+		uint32_t value;
+		check(genip_read_reg(dev_, reg, &value), "genip_read_reg");
+		return value;
+	}
+
+	void write(uint32_t reg, uint32_t value) {
+		check(genip_write_reg(dev_, reg, value), "genip_write_reg");
+	}
+
+	void readBlock(uint32_t reg, uint32_t *values, std::size_t count, uint32_t flags = 0) {
+		check(genip_read_block(dev_, reg, values, count, flags), "genip_read_block");
+	}
+
+	void writeBlock(uint32_t reg, const uint32_t *values, std::size_t count, uint32_t flags = 0) {
+		check(genip_write_block(dev_, reg, values, count, flags), "genip_write_block");
+	}
+
+	void batch(genip_batch_op *ops, std::size_t count) {
+		check(genip_batch(dev_, ops, count), "genip_batch");
+	}
+
+	// waits for an IRQ and returns the IRQ status; timeout_ms < 0 waits forever
+	uint32_t waitIrq(int timeout_ms = -1) {
+		uint32_t status;
+		check(genip_wait_irq(dev_, timeout_ms, &status), "genip_wait_irq");
+		return status;
+	}
+
+	int fd() const { return genip_fd(dev_); }
+	bool mapped() const { return genip_is_mapped(dev_); }
+	const genip_settings &settings() const { return *genip_get_settings(dev_); }
+	genip_dev *get() const { return dev_; }
+
+private:
+	genip_dev *dev_;
+};
+
+// generates e.g. struct DHD { static constexpr genip_ip_type type = GENIP_IP_DHD; enum class Reg {...}; };
+#define GENIP_CXX_REG_ENTRY(ID, NAME, REG) NAME = (REG),
+#define GENIP_CXX_IP_ENTRY(ID) \
+	struct ID { \
+		static constexpr genip_ip_type type = GENIP_IP_##ID; \
+		enum class Reg : uint32_t { GENIP_##ID##_REGS(GENIP_CXX_REG_ENTRY) }; \
+	};
+GENIP_IPCORES(GENIP_CXX_IP_ENTRY)
+#undef GENIP_CXX_IP_ENTRY
+#undef GENIP_CXX_REG_ENTRY
+
+// device of a specific IP type, accessed with that IP's register names
+template <typename IpDesc>
+class Ip : public Device {
+public:
+	using Reg = typename IpDesc::Reg;
+
+	Ip() : Device(IpDesc::type) {}
+	explicit Ip(const char *path) : Device(path) {}
+
+	using Device::read;
+	using Device::write;
+	using Device::readBlock;
+	using Device::writeBlock;
+
+	uint32_t read(Reg reg) { return Device::read(static_cast<uint32_t>(reg)); }
+	void write(Reg reg, uint32_t value) { Device::write(static_cast<uint32_t>(reg), value); }
+
+	void readBlock(Reg reg, uint32_t *values, std::size_t count, uint32_t flags = 0) {
+		Device::readBlock(static_cast<uint32_t>(reg), values, count, flags);
+	}
+
+	void writeBlock(Reg reg, const uint32_t *values, std::size_t count, uint32_t flags = 0) {
+		Device::writeBlock(static_cast<uint32_t>(reg), values, count, flags);
+	}
+};
+
+} // namespace genip
+
+#endif // LIBGENIP_HPP
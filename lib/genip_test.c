@@ -0,0 +1,296 @@
+/*
+ * genip_test - tests for the access path selection of libgenip
+ *
+ * The device is a temporary regular file. ioctl() is replaced by a fake
+ * driver below, so that the fallback and bounds checking logic can be tested
+ * without hardware. mmap() of the regular file stands in for the register
+ * mapping.
+ */
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "genip.h"
+
+#define FAKE_REG_COUNT 64
+
+static uint32_t fake_regs[FAKE_REG_COUNT];
+static int fake_old_driver;     /* reject block and batch ioctls like an older driver */
+static unsigned int fake_calls[16]; /* ioctl calls per command number */
+
+static int failures;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			failures++; \
+		} \
+	} while (0)
+
+// fake driver, overrides the libc ioctl for libgenip
+int ioctl(int fd, unsigned long request, ...) {
+	struct genip_settings *settings;
+	struct genip_reg_access *access;
+	struct genip_block_access *blk;
+	struct genip_batch *batch;
+	struct genip_batch_op *ops;
+	uint32_t *data;
+	unsigned int nr = _IOC_NR(request);
+	va_list ap;
+	void *arg;
+	uint32_t i;
+
+	(void)fd;
+	va_start(ap, request);
+	arg = va_arg(ap, void *);
+	va_end(ap);
+
+	if (nr < 16)
+		fake_calls[nr]++;
+
+	switch (nr) {
+		case GENIP_IOCTL_NR_SETTINGS:
+			settings = arg;
+			settings->base_phys = 0;
+			settings->span = FAKE_REG_COUNT * 4 - 1;
+			return 0;
+
+		case GENIP_IOCTL_NR_REG_WRITE:
+			access = arg;
+			fake_regs[access->offset] = access->value;
+			return 0;
+
+		case GENIP_IOCTL_NR_REG_READ:
+			access = arg;
+			access->value = fake_regs[access->offset];
+			return 0;
+
+		case GENIP_IOCTL_NR_BLOCK_WRITE:
+		case GENIP_IOCTL_NR_BLOCK_READ:
+			if (fake_old_driver)
+				break;
+			blk = arg;
+			data = (uint32_t *)(uintptr_t)blk->data;
+			for (i = 0; i < blk->count; i++) {
+				uint32_t reg = (blk->flags & GENIP_BLOCK_FLAG_FIXED) ? blk->offset : blk->offset + i;
+				if (nr == GENIP_IOCTL_NR_BLOCK_WRITE)
+					fake_regs[reg] = data[i];
+				else
+					data[i] = fake_regs[reg];
+			}
+			return 0;
+
+		case GENIP_IOCTL_NR_BATCH:
+			if (fake_old_driver)
+				break;
+			batch = arg;
+			ops = (struct genip_batch_op *)(uintptr_t)batch->ops;
+			for (i = 0; i < batch->count; i++) {
+				if (ops[i].op == GENIP_BATCH_OP_WRITE)
+					fake_regs[ops[i].reg] = ops[i].value;
+				else
+					ops[i].value = fake_regs[ops[i].reg];
+			}
+			return 0;
+	}
+
+	// the driver answers unknown commands with -EINVAL
+	errno = EINVAL;
+	return -1;
+}
+
+static void fake_reset(int old_driver) {
+	memset(fake_regs, 0, sizeof(fake_regs));
+	memset(fake_calls, 0, sizeof(fake_calls));
+	fake_old_driver = old_driver;
+}
+
+static struct genip_dev *open_fake(const char *path, int mapped) {
+	if (mapped)
+		unsetenv("GENIP_NO_MMAP");
+	else
+		setenv("GENIP_NO_MMAP", "1", 1);
+
+	return genip_open_path(path);
+}
+
+static void test_block_ioctl(const char *path) {
+	uint32_t in[4] = {1, 2, 3, 4};
+	uint32_t out[4] = {0};
+	struct genip_dev *dev;
+
+	fake_reset(0);
+	dev = open_fake(path, 0);
+	CHECK(dev && !genip_is_mapped(dev));
+
+	CHECK(genip_write_block(dev, 8, in, 4, 0) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_WRITE] == 1);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_WRITE] == 0);
+	CHECK(fake_regs[8] == 1 && fake_regs[11] == 4);
+
+	CHECK(genip_read_block(dev, 8, out, 4, 0) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_READ] == 1);
+	CHECK(memcmp(in, out, sizeof(in)) == 0);
+
+	genip_close(dev);
+}
+
+static void test_block_fallback(const char *path) {
+	uint32_t in[4] = {5, 6, 7, 8};
+	uint32_t out[4] = {0};
+	struct genip_dev *dev;
+
+	fake_reset(1);
+	dev = open_fake(path, 0);
+	CHECK(dev != NULL);
+
+	CHECK(genip_write_block(dev, 0, in, 4, 0) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_WRITE] == 1);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_WRITE] == 4);
+	CHECK(fake_regs[0] == 5 && fake_regs[3] == 8);
+
+	// the block ioctls are not tried again once rejected
+	CHECK(genip_read_block(dev, 0, out, 4, 0) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_READ] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_READ] == 4);
+	CHECK(memcmp(in, out, sizeof(in)) == 0);
+
+	// FIXED accesses the same register every time
+	CHECK(genip_write_block(dev, 20, in, 4, GENIP_BLOCK_FLAG_FIXED) == 0);
+	CHECK(fake_regs[20] == 8 && fake_regs[21] == 0);
+
+	genip_close(dev);
+}
+
+static void test_bounds(const char *path) {
+	uint32_t values[FAKE_REG_COUNT + 1] = {0};
+	uint32_t value;
+	struct genip_dev *dev;
+
+	fake_reset(0);
+	dev = open_fake(path, 0);
+	CHECK(dev != NULL);
+
+	CHECK(genip_read_reg(dev, FAKE_REG_COUNT, &value) == -EINVAL);
+	CHECK(genip_write_reg(dev, FAKE_REG_COUNT, 0) == -EINVAL);
+	CHECK(genip_write_block(dev, FAKE_REG_COUNT - 2, values, 3, 0) == -EINVAL);
+	CHECK(genip_read_block(dev, 0, values, FAKE_REG_COUNT + 1, 0) == -EINVAL);
+	CHECK(genip_write_block(dev, 0, values, 1, 0x80) == -EINVAL);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_READ] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_WRITE] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_WRITE] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_READ] == 0);
+
+	// FIXED is not limited by the register area, only its register is
+	CHECK(genip_write_block(dev, FAKE_REG_COUNT - 1, values, FAKE_REG_COUNT + 1, GENIP_BLOCK_FLAG_FIXED) == 0);
+	CHECK(genip_write_block(dev, FAKE_REG_COUNT, values, 1, GENIP_BLOCK_FLAG_FIXED) == -EINVAL);
+
+	genip_close(dev);
+}
+
+static void test_batch(const char *path) {
+	struct genip_batch_op ops[3] = {
+		{.reg = 3, .value = 0x33, .op = GENIP_BATCH_OP_WRITE},
+		{.reg = 40, .value = 0x40, .op = GENIP_BATCH_OP_WRITE},
+		{.reg = 3, .op = GENIP_BATCH_OP_READ},
+	};
+	struct genip_batch_op bad = {.reg = 0, .op = 7};
+	struct genip_dev *dev;
+
+	fake_reset(0);
+	dev = open_fake(path, 0);
+	CHECK(dev != NULL);
+	CHECK(genip_batch(dev, ops, 3) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BATCH] == 1);
+	CHECK(ops[2].value == 0x33 && fake_regs[40] == 0x40);
+	CHECK(genip_batch(dev, &bad, 1) == -EINVAL);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BATCH] == 1);
+	genip_close(dev);
+
+	fake_reset(1);
+	ops[2].value = 0;
+	dev = open_fake(path, 0);
+	CHECK(dev != NULL);
+	CHECK(genip_batch(dev, ops, 3) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_WRITE] == 2);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_READ] == 1);
+	CHECK(ops[2].value == 0x33 && fake_regs[40] == 0x40);
+	genip_close(dev);
+}
+
+static void test_mapped(const char *path) {
+	struct genip_batch_op op = {.reg = 5, .op = GENIP_BATCH_OP_READ};
+	uint32_t in[2] = {0xaa, 0xbb};
+	uint32_t value;
+	struct genip_dev *dev;
+
+	fake_reset(0);
+	dev = open_fake(path, 1);
+	CHECK(dev && genip_is_mapped(dev));
+
+	CHECK(genip_write_reg(dev, 5, 0x1234) == 0);
+	CHECK(genip_read_reg(dev, 5, &value) == 0 && value == 0x1234);
+	CHECK(genip_write_block(dev, 6, in, 2, 0) == 0);
+	CHECK(genip_batch(dev, &op, 1) == 0 && op.value == 0x1234);
+	CHECK(genip_read_reg(dev, 7, &value) == 0 && value == 0xbb);
+
+	// only the settings were queried through the driver
+	CHECK(fake_calls[GENIP_IOCTL_NR_SETTINGS] == 1);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_WRITE] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_REG_READ] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_WRITE] == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BATCH] == 0);
+
+	genip_close(dev);
+}
+
+// a refused mapping (e.g. EBUSY while recording) falls back to the ioctls
+static void test_map_refused(void) {
+	uint32_t in[2] = {0x11, 0x22};
+	struct genip_dev *dev;
+
+	fake_reset(0);
+	// /dev/null can't be mapped
+	dev = open_fake("/dev/null", 1);
+	CHECK(dev && !genip_is_mapped(dev));
+
+	CHECK(genip_write_block(dev, 2, in, 2, 0) == 0);
+	CHECK(fake_calls[GENIP_IOCTL_NR_BLOCK_WRITE] == 1);
+	CHECK(fake_regs[2] == 0x11 && fake_regs[3] == 0x22);
+
+	genip_close(dev);
+}
+
+int main(void) {
+	char path[] = "/tmp/genip_test_XXXXXX";
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0 || ftruncate(fd, sysconf(_SC_PAGESIZE)) < 0) {
+		perror(path);
+		return 1;
+	}
+	close(fd);
+
+	test_block_ioctl(path);
+	test_block_fallback(path);
+	test_bounds(path);
+	test_batch(path);
+	test_mapped(path);
+	test_map_refused();
+
+	unlink(path);
+
+	if (failures) {
+		fprintf(stderr, "%d checks failed\n", failures);
+		return 1;
+	}
+	printf("all tests passed\n");
+	return 0;
+}
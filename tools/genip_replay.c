@@ -0,0 +1,253 @@
+/*
+ * genip_replay - replay a register access recording through the ioctl interface
+ *
+ * Record:  echo 1 > /sys/kernel/debug/tes-ipcore/trace_enable
+ *          cat /sys/kernel/debug/tes-ipcore/trace > workload.trace
+ * Replay:  genip_replay [-f] [-v] [-t ms] workload.trace
+ *
+ * Accesses the driver did itself in interrupt context (reading and clearing
+ * the IRQ status) are skipped; an IRQ record waits for the interrupt using
+ * poll() and a read on the device, just like a regular client would.
+ * The driver ORs interrupts into one status until it is read, so the status
+ * bits of a read are kept and satisfy later IRQ records as well. An IRQ that
+ * does not arrive within the timeout is reported and the replay goes on.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "genip_module.h"
+
+#define SYSFS_CLASS_DIR "/sys/class/" GENIP_DEVCLASS_NAME
+#define DEFAULT_IRQ_TIMEOUT_MS 1000
+
+static int dev_fd[256];
+static uint32_t dev_irq_pending[256]; // IRQ status read but not yet matched to a record
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t t) {
+	struct timespec ts = {
+		.tv_sec = t / 1000000000ull,
+		.tv_nsec = t % 1000000000ull,
+	};
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+		;
+}
+
+// map recorded minor numbers to device files using the device class in sysfs
+static int open_devices(void) {
+	DIR *dir;
+	struct dirent *ent;
+	char path[512];
+	FILE *f;
+	unsigned int major, minor;
+	int count = 0;
+
+	dir = opendir(SYSFS_CLASS_DIR);
+	if (!dir) {
+		perror(SYSFS_CLASS_DIR);
+		return -1;
+	}
+
+	while ((ent = readdir(dir))) {
+		if (ent->d_name[0] == '.')
+			continue;
+
+		snprintf(path, sizeof(path), SYSFS_CLASS_DIR "/%s/dev", ent->d_name);
+		f = fopen(path, "r");
+		if (!f)
+			continue;
+		if (fscanf(f, "%u:%u", &major, &minor) == 2 && minor < 256) {
+			snprintf(path, sizeof(path), "/dev/%s", ent->d_name);
+			dev_fd[minor] = open(path, O_RDWR | O_NONBLOCK);
+			if (dev_fd[minor] < 0)
+				perror(path);
+			else
+				count++;
+		}
+		fclose(f);
+	}
+	closedir(dir);
+
+	return count;
+}
+
+/*
+ * wait until the IRQ status bits of a record have been seen on the device
+ * returns 0 on success, 1 on timeout and -1 on error
+ */
+static int wait_irq(unsigned int dev, uint32_t status, int timeout_ms) {
+	struct pollfd pfd = {.fd = dev_fd[dev], .events = POLLIN};
+	uint64_t deadline = now_ns() + (uint64_t)timeout_ms * 1000000ull;
+	uint64_t now;
+	uint32_t irq_stat;
+	int result;
+
+	while ((dev_irq_pending[dev] & status) != status) {
+		now = now_ns();
+		if (now >= deadline)
+			return 1;
+
+		result = poll(&pfd, 1, (deadline - now + 999999) / 1000000);
+		if (result < 0 && errno != EINTR) {
+			perror("poll");
+			return -1;
+		}
+		if (result <= 0)
+			continue;
+
+		if (read(dev_fd[dev], &irq_stat, sizeof(irq_stat)) < 0) {
+			if (errno == EAGAIN || errno == EINTR)
+				continue;
+			perror("waiting for IRQ");
+			return -1;
+		}
+		dev_irq_pending[dev] |= irq_stat;
+	}
+
+	dev_irq_pending[dev] &= ~status;
+	return 0;
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-f] [-v] [-t ms] <recording>\n"
+			"  -f  replay as fast as possible instead of honouring the recorded timing\n"
+			"  -v  report register reads returning a different value than recorded\n"
+			"  -t  time to wait for a recorded IRQ in ms (default %d)\n", prog, DEFAULT_IRQ_TIMEOUT_MS);
+}
+
+int main(int argc, char **argv) {
+	struct genip_trace_record rec;
+	struct genip_reg_access access;
+	uint64_t first_ts = 0, start = 0, last_ts = 0;
+	unsigned long replayed = 0, mismatches = 0, missed_irqs = 0;
+	int fast = 0, verbose = 0;
+	int irq_timeout_ms = DEFAULT_IRQ_TIMEOUT_MS;
+	FILE *in;
+	int result;
+	int fd;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "fvt:h")) != -1) {
+		switch (opt) {
+			case 'f':
+				fast = 1;
+				break;
+			case 'v':
+				verbose = 1;
+				break;
+			case 't':
+				irq_timeout_ms = atoi(optarg);
+				if (irq_timeout_ms <= 0) {
+					usage(argv[0]);
+					return 1;
+				}
+				break;
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind != argc - 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	in = fopen(argv[optind], "rb");
+	if (!in) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	for (i = 0; i < 256; i++)
+		dev_fd[i] = -1;
+	if (open_devices() <= 0) {
+		fprintf(stderr, "no %s devices found\n", GENIP_DRIVER_NAME);
+		return 1;
+	}
+
+	while (fread(&rec, sizeof(rec), 1, in) == 1) {
+		// register accesses of the driver's own IRQ handling are not replayed,
+		// but the IRQ records themselves (always in IRQ context) are waited for
+		if ((rec.flags & GENIP_TRACE_FLAG_IRQ_CTX) && rec.op != GENIP_TRACE_OP_IRQ)
+			continue;
+
+		fd = dev_fd[rec.dev];
+		if (fd < 0) {
+			fprintf(stderr, "recording references unknown device minor %u\n", rec.dev);
+			return 1;
+		}
+
+		if (!replayed) {
+			first_ts = rec.ts;
+			start = now_ns();
+		} else if (!fast) {
+			sleep_until_ns(start + (rec.ts - first_ts));
+		}
+		last_ts = rec.ts;
+
+		switch (rec.op) {
+			case GENIP_TRACE_OP_WRITE:
+				access.offset = rec.reg;
+				access.value = rec.value;
+				if (ioctl(fd, GENIP_IOCTL_W, &access) < 0) {
+					perror("GENIP_IOCTL_W");
+					return 1;
+				}
+				break;
+
+			case GENIP_TRACE_OP_READ:
+				access.offset = rec.reg;
+				if (ioctl(fd, GENIP_IOCTL_R, &access) < 0) {
+					perror("GENIP_IOCTL_R");
+					return 1;
+				}
+				if (access.value != rec.value) {
+					mismatches++;
+					if (verbose)
+						printf("dev %u reg 0x%04x: read 0x%08x, recorded 0x%08x\n",
+							   rec.dev, rec.reg, access.value, rec.value);
+				}
+				break;
+
+			case GENIP_TRACE_OP_IRQ:
+				result = wait_irq(rec.dev, rec.value, irq_timeout_ms);
+				if (result < 0)
+					return 1;
+				if (result) {
+					missed_irqs++;
+					fprintf(stderr, "dev %u: IRQ 0x%08x recorded at %.3f ms did not arrive within %d ms\n",
+							rec.dev, rec.value, (rec.ts - first_ts) / 1e6, irq_timeout_ms);
+				}
+				break;
+
+			default:
+				fprintf(stderr, "unknown record op %u\n", rec.op);
+				return 1;
+		}
+		replayed++;
+	}
+
+	printf("replayed %lu records in %.3f ms (recorded: %.3f ms), %lu read mismatches, %lu missed IRQs\n",
+		   replayed, (now_ns() - start) / 1e6, (last_ts - first_ts) / 1e6, mismatches, missed_irqs);
+
+	fclose(in);
+	return 0;
+}